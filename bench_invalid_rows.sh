@@ -0,0 +1,67 @@
+#!/bin/sh
+# Стоимость некорректных строк по сравнению с корректными.
+#
+#   ./bench_invalid_rows.sh ./task_n3
+#
+# Программа должна быть собрана с DEFINES += PHYSICS_TRACE. Скрипт дважды
+# запускает перебор в одном процессе - по сетке, где все строки допустимы,
+# и по сетке целиком вне области допустимых значений, - и делит время
+# интервала sweep.kernel на число строк; из REPEAT запусков (по умолчанию 5)
+# берётся самый быстрый. Проверка идёт битами статуса без исключений,
+# поэтому некорректная строка не должна стоить дороже.
+
+set -e
+
+repeat=${REPEAT:-5}
+
+if [ $# -ne 1 ]; then
+    echo "usage: $0 path/to/task_nX" >&2
+    exit 2
+fi
+
+program=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+task=$(basename "$1")
+
+case "$task" in
+task_n3*)
+    valid="--m1 0.5:1:50 --m2 1:5:50 --L 0.5:2:4 --theta 1:59:59"
+    invalid="--m1 -1:-0.1:50 --m2 1:5:50 --L 0.5:2:4 --theta 91:179:59" ;;
+task_n4*)
+    valid="--M 0.5:5:50 --m 0.1:3:50 --alpha 1:89:89 --H 0.5:2:2"
+    invalid="--M 0.5:5:50 --m 0.1:3:50 --alpha 91:179:89 --H -2:-0.5:2" ;;
+task_n5*)
+    valid="--m 0.5:5:20 --L 0.2:3:10 --w0 0.5:5:40 --w 10:30:60"
+    invalid="--m 0.5:5:20 --L 0.2:3:10 --w0 0.5:5:40 --w 0.1:0.4:60" ;;
+*)
+    echo "$0: перебор есть только у task_n3, task_n4 и task_n5" >&2
+    exit 2 ;;
+esac
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cd "$dir"
+
+# Время ядра на строку, нс.
+run() {
+    best=
+    i=0
+    while [ $i -lt "$repeat" ]; do
+        rm -f ./*.metrics.txt
+        "$program" --sweep --shards 1 --jobs 1 --out grid.csv $1 >/dev/null
+        seconds=$(sed -n 's/^physics_span_seconds_sum{span="sweep.kernel"} //p' \
+                  "${task%%.*}.shard0.metrics.txt")
+        if [ -z "$seconds" ]; then
+            echo "$0: нет интервала sweep.kernel - программа собрана без PHYSICS_TRACE?" >&2
+            exit 1
+        fi
+        best=$(awk -v s="$seconds" -v b="$best" 'BEGIN { print (b == "" || s < b) ? s : b }')
+        i=$((i + 1))
+    done
+    rows=$(sed -n 's/^rows //p' grid.csv.summary.txt)
+    valid_rows=$(sed -n 's/^valid //p' grid.csv.summary.txt)
+    awk -v s="$best" -v n="$rows" -v v="$valid_rows" -v label="$2" \
+        'BEGIN { printf "%-12s %9d строк (допустимых %d): %.1f нс/строку\n", label, n, v, s * 1e9 / n }'
+}
+
+run "$valid" "корректные"
+run "$invalid" "некорректные"
@@ -0,0 +1,563 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+// Перебор параметров по сетке без графического интерфейса.
+//
+//   task_n3 --sweep --shards 8 --jobs 4 --out sweep.csv
+//           --m1 0.1:10:100 --m2 1:1:1 --L 0.5:2:50 --theta 1:89:89
+//
+// Каждая ось задаётся как min:max:count. Сетка из всех сочетаний (последняя
+// ось меняется быстрее всех) делится на --shards непрерывных кусков по номеру
+// строки, каждый кусок считает отдельный процесс (--worker k) и дописывает
+// результаты в sweep.csv.part<k> блоками. Если процесс убит, при следующем
+// запуске он продолжает с последнего записанного блока. После всех кусков
+// части склеиваются по порядку в sweep.csv, общие минимумы/максимумы
+// пишутся в sweep.csv.summary.txt, а точки, где вдоль последней оси
+// меняется статус (граница области допустимых значений), - в
+// sweep.csv.boundary.csv. Каждая строка считается независимо и склейка
+// идёт в порядке номеров строк, поэтому результат побитово одинаков при
+// любом числе кусков. Части удаляются, только если всё записано.
+//
+// Часть пишет только один процесс: рядом с ней лежит sweep.csv.part<k>.lock
+// (QLockFile). Процесс, осиротевший после гибели координатора, держит его
+// до конца, и новый процесс того же куска ждёт, а не пишет параллельно.
+//
+// Вместе с формулами каждая строка проходит проверку законов сохранения:
+// ядро задачи в том же цикле заново считает сохраняющиеся величины по
+// входам и ответам и возвращает их относительный уход. Строки, где уход
+// больше --tolerance (по умолчанию 1e-9) или не конечен, отмечаются в
+// столбце audit. В сводку пишутся число таких строк (неконечные - отдельно)
+// и средний, среднеквадратичный и наибольший конечный уход.
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QLockFile>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "trace.h"
+
+namespace sweep {
+
+const int kMaxInputs = 4;
+const int kMaxOutputs = 3;
+const int kMaxAudits = 2;
+const int kBlockRows = 4096;
+const int kMaxAttempts = 3;
+const int kPollMs = 10;
+
+// Считает n строк: входы in[n][inputs], выходы out[n][outputs], статусы
+// status[n] и относительный уход законов сохранения drift[n][audits].
+typedef void (*BlockKernel)(const double *in, double *out, unsigned *status, double *drift, int n);
+
+struct Task {
+    const char *name;
+    int inputs;
+    const char *inputNames[kMaxInputs];
+    int outputs;
+    const char *outputNames[kMaxOutputs];
+    const char *const *statusMessages;
+    int statusCount;
+    BlockKernel kernel;
+    int audits;
+    const char *auditNames[kMaxAudits];
+};
+
+struct Axis {
+    double min, max;
+    int64_t count;
+
+    double at(int64_t i) const {
+        return count == 1 ? min : min + (max - min) * (double(i) / double(count - 1));
+    }
+};
+
+struct Grid {
+    std::vector<Axis> axes;
+
+    int64_t rows() const {
+        int64_t n = 1;
+        for (const Axis &a : axes) n *= a.count;
+        return n;
+    }
+
+    void point(int64_t row, double *x) const {
+        for (int k = int(axes.size()) - 1; k >= 0; --k) {
+            x[k] = axes[k].at(row % axes[k].count);
+            row /= axes[k].count;
+        }
+    }
+};
+
+struct Options {
+    int worker = -1;
+    int shards = 1;
+    int jobs = QThread::idealThreadCount();
+    double tolerance = 1e-9;
+    QString out = "sweep.csv";
+    QStringList axisSpecs;
+    Grid grid;
+};
+
+struct Record {
+    double out[kMaxOutputs];
+    double drift[kMaxAudits];
+    uint32_t status;
+    uint32_t audit;
+};
+
+struct PartHeader {
+    char magic[8];
+    uint64_t fingerprint;
+    int64_t begin, end;
+};
+
+inline bool requested(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--sweep") || !std::strcmp(argv[i], "--worker"))
+            return true;
+    }
+    return false;
+}
+
+inline FILE *openFile(const QString &path, const char *mode) {
+    return std::fopen(path.toLocal8Bit().constData(), mode);
+}
+
+inline QString partPath(const Options &opt, int shard) {
+    return opt.out + ".part" + QString::number(shard);
+}
+
+inline int64_t shardBegin(const Options &opt, int shard) {
+    return opt.grid.rows() * shard / opt.shards;
+}
+
+inline bool parseAxis(const QString &spec, Axis &axis) {
+    QStringList parts = spec.split(":");
+    if (parts.size() != 3) return false;
+    bool ok1, ok2, ok3;
+    axis.min = parts[0].toDouble(&ok1);
+    axis.max = parts[1].toDouble(&ok2);
+    axis.count = parts[2].toLongLong(&ok3);
+    return ok1 && ok2 && ok3 && axis.count > 0;
+}
+
+inline bool parseOptions(const Task &task, const QStringList &args, Options &opt) {
+    QStringList specs;
+    for (int i = 0; i < task.inputs; ++i) specs << QString();
+
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &a = args[i];
+        if (a == "--sweep") continue;
+        if (i + 1 >= args.size()) {
+            std::fprintf(stderr, "%s: нет значения для %s\n", task.name, a.toLocal8Bit().constData());
+            return false;
+        }
+        const QString &v = args[++i];
+        bool ok = true;
+        if (a == "--worker") opt.worker = v.toInt(&ok);
+        else if (a == "--shards") opt.shards = v.toInt(&ok);
+        else if (a == "--jobs") opt.jobs = v.toInt(&ok);
+        else if (a == "--out") opt.out = v;
+        else if (a == "--tolerance") opt.tolerance = v.toDouble(&ok);
+        else {
+            int k = 0;
+            while (k < task.inputs && a != QString("--") + task.inputNames[k]) ++k;
+            if (k == task.inputs) {
+                std::fprintf(stderr, "%s: неизвестный параметр %s\n", task.name, a.toLocal8Bit().constData());
+                return false;
+            }
+            specs[k] = v;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "%s: неверное значение %s для %s\n", task.name,
+                         v.toLocal8Bit().constData(), a.toLocal8Bit().constData());
+            return false;
+        }
+    }
+
+    for (int k = 0; k < task.inputs; ++k) {
+        Axis axis;
+        if (!parseAxis(specs[k], axis)) {
+            std::fprintf(stderr, "%s: ось --%s должна быть задана как min:max:count\n",
+                         task.name, task.inputNames[k]);
+            return false;
+        }
+        opt.grid.axes.push_back(axis);
+        opt.axisSpecs << QString("--") + task.inputNames[k] << specs[k];
+    }
+    if (opt.shards < 1 || opt.jobs < 1 || opt.worker < -1 || opt.worker >= opt.shards
+        || !(opt.tolerance > 0)) {
+        std::fprintf(stderr, "%s: неверные --shards/--jobs/--worker/--tolerance\n", task.name);
+        return false;
+    }
+    return true;
+}
+
+// Отпечаток сетки и разбиения: чужие или устаревшие части не продолжаются.
+inline uint64_t fingerprint(const Task &task, const Options &opt) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void *data, std::size_t size) {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    mix(task.name, std::strlen(task.name));
+    for (const Axis &a : opt.grid.axes) {
+        mix(&a.min, sizeof a.min);
+        mix(&a.max, sizeof a.max);
+        mix(&a.count, sizeof a.count);
+    }
+    mix(&opt.shards, sizeof opt.shards);
+    mix(&opt.tolerance, sizeof opt.tolerance);
+    return h;
+}
+
+inline PartHeader partHeader(const Task &task, const Options &opt, int shard) {
+    PartHeader header;
+    std::memset(&header, 0, sizeof header);
+    std::memcpy(header.magic, "SWEEP02", 8);
+    header.fingerprint = fingerprint(task, opt);
+    header.begin = shardBegin(opt, shard);
+    header.end = shardBegin(opt, shard + 1);
+    return header;
+}
+
+inline int runWorker(const Task &task, const Options &opt) {
+    const int shard = opt.worker;
+    const PartHeader header = partHeader(task, opt, shard);
+    const int64_t begin = header.begin;
+    const int64_t end = header.end;
+    const QString path = partPath(opt, shard);
+
+    QLockFile lock(path + ".lock");
+    lock.setStaleLockTime(0);
+    if (!lock.tryLock(0)) {
+        std::fprintf(stderr, "%s: кусок %d считает другой процесс, ожидание\n", task.name, shard);
+        if (!lock.lock()) {
+            std::fprintf(stderr, "%s: не удалось заблокировать %s.lock\n",
+                         task.name, path.toLocal8Bit().constData());
+            return 1;
+        }
+    }
+
+    int64_t done = 0;
+    QFile f(path);
+    if (f.open(QIODevice::ReadWrite)) {
+        PartHeader old;
+        if (f.read(reinterpret_cast<char *>(&old), sizeof old) == qint64(sizeof old)
+            && !std::memcmp(&old, &header, sizeof header)) {
+            done = std::min<int64_t>((f.size() - qint64(sizeof header)) / qint64(sizeof(Record)), end - begin);
+        }
+    }
+    if (done == 0) {
+        f.close();
+        if (!f.open(QIODevice::ReadWrite | QIODevice::Truncate)
+            || f.write(reinterpret_cast<const char *>(&header), sizeof header) != qint64(sizeof header)) {
+            std::fprintf(stderr, "%s: не удалось записать %s\n", task.name, path.toLocal8Bit().constData());
+            return 1;
+        }
+    } else {
+        std::fprintf(stderr, "%s: кусок %d продолжается со строки %lld\n",
+                     task.name, shard, static_cast<long long>(begin + done));
+    }
+    f.seek(sizeof header + done * sizeof(Record));
+
+    std::vector<double> in(kBlockRows * task.inputs);
+    std::vector<double> out(kBlockRows * task.outputs);
+    std::vector<unsigned> status(kBlockRows);
+    std::vector<double> drift(kBlockRows * kMaxAudits);
+    std::vector<Record> records(kBlockRows);
+
+    for (int64_t row = begin + done; row < end; row += kBlockRows) {
+        TRACE_SPAN(span, "sweep.grid");
+        int n = int(std::min<int64_t>(kBlockRows, end - row));
+        for (int i = 0; i < n; ++i)
+            opt.grid.point(row + i, &in[i * task.inputs]);
+        TRACE_NEXT(span, "sweep.kernel");
+        task.kernel(in.data(), out.data(), status.data(), drift.data(), n);
+        TRACE_NEXT(span, "sweep.write");
+        for (int i = 0; i < n; ++i) {
+            Record &r = records[i];
+            std::memset(&r, 0, sizeof(Record));
+            for (int j = 0; j < task.outputs; ++j)
+                r.out[j] = out[i * task.outputs + j];
+            r.status = status[i];
+            for (int k = 0; k < task.audits; ++k) {
+                r.drift[k] = drift[i * task.audits + k];
+                r.audit |= unsigned(status[i] == 0 && !(std::fabs(r.drift[k]) <= opt.tolerance)) << k;
+            }
+        }
+        qint64 bytes = qint64(n * sizeof(Record));
+        if (f.write(reinterpret_cast<const char *>(records.data()), bytes) != bytes || !f.flush()) {
+            std::fprintf(stderr, "%s: не удалось записать %s\n", task.name, path.toLocal8Bit().constData());
+            return 1;
+        }
+        TRACE_ADD("sweep.rows", n);
+    }
+    return 0;
+}
+
+inline bool launchWorkers(const Task &task, const Options &opt) {
+    struct Job {
+        int shard;
+        int attempts;
+        QProcess *process;
+    };
+    std::vector<Job> pending, running;
+    for (int k = opt.shards - 1; k >= 0; --k) pending.push_back({k, 0, nullptr});
+
+    const QString program = QCoreApplication::applicationFilePath();
+    bool ok = true;
+    auto retry = [&](Job job, const char *what) {
+        delete job.process;
+        job.process = nullptr;
+        if (++job.attempts < kMaxAttempts) {
+            std::fprintf(stderr, "%s: кусок %d %s, перезапуск\n", task.name, job.shard, what);
+            pending.push_back(job);
+        } else {
+            std::fprintf(stderr, "%s: кусок %d не удалось посчитать\n", task.name, job.shard);
+            ok = false;
+        }
+    };
+
+    while (!pending.empty() || !running.empty()) {
+        while (!pending.empty() && int(running.size()) < opt.jobs) {
+            Job job = pending.back();
+            pending.pop_back();
+            QStringList args;
+            args << "--worker" << QString::number(job.shard)
+                 << "--shards" << QString::number(opt.shards)
+                 << "--out" << opt.out
+                 << "--tolerance" << QString::number(opt.tolerance, 'g', 17);
+            args += opt.axisSpecs;
+            job.process = new QProcess;
+            job.process->setProcessChannelMode(QProcess::ForwardedChannels);
+            job.process->start(program, args);
+            // Незапустившийся процесс после waitForFinished сообщает
+            // NormalExit с кодом 0, поэтому запуск проверяется отдельно.
+            if (job.process->waitForStarted(-1))
+                running.push_back(job);
+            else
+                retry(job, "не запустился");
+        }
+        if (running.empty()) continue;
+
+        // Ждём первый завершившийся кусок, какой бы он ни был: упавший
+        // кусок перезапускается, не дожидаясь соседей.
+        std::size_t i = 0;
+        while (running[i].process->state() != QProcess::NotRunning
+               && !running[i].process->waitForFinished(kPollMs))
+            i = (i + 1) % running.size();
+
+        Job job = running[i];
+        running.erase(running.begin() + i);
+        if (job.process->exitStatus() == QProcess::NormalExit && job.process->exitCode() == 0) {
+            delete job.process;
+            continue;
+        }
+        retry(job, "прерван");
+    }
+    return ok;
+}
+
+struct Extremum {
+    double value = NAN;
+    int64_t row = -1;
+};
+
+struct Drift {
+    int64_t flagged = 0;
+    int64_t finite = 0;
+    int64_t nonFinite = 0;
+    double sumAbs = 0;
+    double sumSquares = 0;
+    Extremum worst;
+};
+
+inline int merge(const Task &task, const Options &opt) {
+    TRACE_SPAN(span, "sweep.merge");
+    const QString boundaryPath = opt.out + ".boundary.csv";
+    const QString summaryPath = opt.out + ".summary.txt";
+    FILE *csv = openFile(opt.out, "w");
+    FILE *boundary = openFile(boundaryPath, "w");
+    FILE *summary = nullptr;
+    auto fail = [&](const char *what, const QString &path) {
+        std::fprintf(stderr, "%s: %s %s\n", task.name, what, path.toLocal8Bit().constData());
+        if (csv) std::fclose(csv);
+        if (boundary) std::fclose(boundary);
+        if (summary) std::fclose(summary);
+        return 1;
+    };
+    // Ошибка записи (например, кончилось место) видна только по ferror и
+    // результату fclose; без этой проверки части удалились бы зря.
+    auto finish = [](FILE *&file) {
+        bool ok = !std::ferror(file);
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    };
+    if (!csv) return fail("не удалось записать", opt.out);
+    if (!boundary) return fail("не удалось записать", boundaryPath);
+
+    for (int k = 0; k < task.inputs; ++k) std::fprintf(csv, "%s,", task.inputNames[k]);
+    for (int j = 0; j < task.outputs; ++j) std::fprintf(csv, "%s,", task.outputNames[j]);
+    std::fputs("status", csv);
+    for (int k = 0; k < task.audits; ++k) std::fprintf(csv, ",drift_%s", task.auditNames[k]);
+    std::fputs(task.audits > 0 ? ",audit\n" : "\n", csv);
+    for (int k = 0; k < task.inputs; ++k) std::fprintf(boundary, "%s,", task.inputNames[k]);
+    std::fputs("status_before,status_after\n", boundary);
+
+    const int64_t lastAxis = opt.grid.axes.back().count;
+    int64_t valid = 0, transitions = 0;
+    std::vector<int64_t> statusCounts(task.statusCount, 0);
+    Extremum minimum[kMaxOutputs], maximum[kMaxOutputs];
+    Drift drifts[kMaxAudits];
+    unsigned previous = 0;
+    double x[kMaxInputs];
+    std::vector<Record> records(kBlockRows);
+
+    for (int shard = 0; shard < opt.shards; ++shard) {
+        // Заголовок сверяется так же, как в runWorker: часть от другой
+        // сетки или другого разбиения с тем же --out не склеивается.
+        const QString path = partPath(opt, shard);
+        const PartHeader header = partHeader(task, opt, shard);
+        QFile part(path);
+        PartHeader found;
+        if (!part.open(QIODevice::ReadOnly))
+            return fail("не удалось открыть", path);
+        if (part.read(reinterpret_cast<char *>(&found), sizeof found) != qint64(sizeof found)
+            || std::memcmp(&found, &header, sizeof header))
+            return fail("часть от другого перебора:", path);
+        for (int64_t row = header.begin; row < header.end; row += kBlockRows) {
+            int n = int(std::min<int64_t>(kBlockRows, header.end - row));
+            qint64 bytes = qint64(n * sizeof(Record));
+            if (part.read(reinterpret_cast<char *>(records.data()), bytes) != bytes)
+                return fail("часть оборвана:", path);
+            for (int i = 0; i < n; ++i) {
+                const Record &r = records[i];
+                const int64_t index = row + i;
+                opt.grid.point(index, x);
+                for (int k = 0; k < task.inputs; ++k) std::fprintf(csv, "%.17g,", x[k]);
+
+                if (index % lastAxis != 0 && r.status != previous) {
+                    for (int k = 0; k < task.inputs; ++k) std::fprintf(boundary, "%.17g,", x[k]);
+                    std::fprintf(boundary, "%u,%u\n", previous, r.status);
+                    ++transitions;
+                }
+                previous = r.status;
+
+                if (r.status != 0) {
+                    for (int j = 0; j < task.outputs; ++j) std::fputc(',', csv);
+                    for (int b = 0; b < task.statusCount; ++b)
+                        statusCounts[b] += (r.status >> b) & 1u;
+                } else {
+                    ++valid;
+                    for (int j = 0; j < task.outputs; ++j) {
+                        double y = r.out[j];
+                        std::fprintf(csv, "%.17g,", y);
+                        if (minimum[j].row < 0 || y < minimum[j].value) minimum[j] = {y, index};
+                        if (maximum[j].row < 0 || y > maximum[j].value) maximum[j] = {y, index};
+                    }
+                }
+                std::fprintf(csv, "%u", r.status);
+
+                for (int k = 0; k < task.audits; ++k) {
+                    if (r.status != 0) {
+                        std::fputc(',', csv);
+                        continue;
+                    }
+                    double d = std::fabs(r.drift[k]);
+                    std::fprintf(csv, ",%.17g", r.drift[k]);
+                    Drift &s = drifts[k];
+                    if (!std::isfinite(d)) {
+                        ++s.nonFinite;
+                        continue;
+                    }
+                    ++s.finite;
+                    s.flagged += (r.audit >> k) & 1u;
+                    s.sumAbs += d;
+                    s.sumSquares += d * d;
+                    if (s.worst.row < 0 || d > s.worst.value) s.worst = {d, index};
+                }
+                if (task.audits > 0) std::fprintf(csv, ",%u", r.audit);
+                std::fputc('\n', csv);
+            }
+        }
+    }
+    if (!finish(csv)) return fail("не удалось записать", opt.out);
+    if (!finish(boundary)) return fail("не удалось записать", boundaryPath);
+
+    summary = openFile(summaryPath, "w");
+    if (!summary) return fail("не удалось записать", summaryPath);
+    std::fprintf(summary, "rows %lld\nvalid %lld\n",
+                 static_cast<long long>(opt.grid.rows()), static_cast<long long>(valid));
+    for (int b = 0; b < task.statusCount; ++b)
+        std::fprintf(summary, "status %u (%s): %lld\n", 1u << b, task.statusMessages[b],
+                     static_cast<long long>(statusCounts[b]));
+    for (int j = 0; j < task.outputs; ++j) {
+        const Extremum *e[2] = {&minimum[j], &maximum[j]};
+        const char *label[2] = {"min", "max"};
+        for (int t = 0; t < 2; ++t) {
+            if (e[t]->row < 0) continue;
+            opt.grid.point(e[t]->row, x);
+            std::fprintf(summary, "%s %s %.17g at", task.outputNames[j], label[t], e[t]->value);
+            for (int k = 0; k < task.inputs; ++k)
+                std::fprintf(summary, " %s=%.17g", task.inputNames[k], x[k]);
+            std::fputc('\n', summary);
+        }
+    }
+    std::fprintf(summary, "validity transitions %lld\n", static_cast<long long>(transitions));
+    for (int k = 0; k < task.audits; ++k) {
+        const Drift &s = drifts[k];
+        std::fprintf(summary, "drift %s: flagged %lld (tolerance %.3g), non-finite %lld, "
+                              "mean %.3g, rms %.3g over %lld rows",
+                     task.auditNames[k], static_cast<long long>(s.flagged), opt.tolerance,
+                     static_cast<long long>(s.nonFinite),
+                     s.finite ? s.sumAbs / s.finite : 0.0,
+                     s.finite ? std::sqrt(s.sumSquares / s.finite) : 0.0,
+                     static_cast<long long>(s.finite));
+        if (s.worst.row >= 0) {
+            opt.grid.point(s.worst.row, x);
+            std::fprintf(summary, ", max %.3g at", s.worst.value);
+            for (int i = 0; i < task.inputs; ++i)
+                std::fprintf(summary, " %s=%.17g", task.inputNames[i], x[i]);
+        }
+        std::fputc('\n', summary);
+    }
+    if (!finish(summary)) return fail("не удалось записать", summaryPath);
+
+    for (int shard = 0; shard < opt.shards; ++shard)
+        QFile::remove(partPath(opt, shard));
+    return 0;
+}
+
+inline int run(const Task &task, const QStringList &args) {
+    Options opt;
+    if (!parseOptions(task, args, opt)) return 2;
+
+    int rc;
+    if (opt.worker >= 0) {
+        rc = runWorker(task, opt);
+        TRACE_DUMP(QString("%1.shard%2").arg(task.name).arg(opt.worker).toStdString());
+    } else {
+        rc = launchWorkers(task, opt) ? merge(task, opt) : 1;
+        TRACE_DUMP(QString("%1.sweep").arg(task.name).toStdString());
+    }
+    return rc;
+}
+
+} // namespace sweep
+
+#endif // SWEEP_H
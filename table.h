@@ -0,0 +1,268 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+// Предвычисленные таблицы для быстрого приближённого ответа при вводе.
+//
+// Ответы задач зависят от безразмерных групп (отношение масс, угол,
+// Lω²/g), а размерные величины входят простыми множителями. Поэтому
+// точное решение один раз считается на сетке по одной-двум таким группам,
+// таблица сохраняется на диск и при запуске отображается в память, а
+// запрос - это билинейная интерполяция по четырём соседним узлам.
+//
+//   task_n3 --build-table
+//
+// строит таблицу в несколько потоков рядом с программой (task_n3.table
+// в каталоге исполняемого файла - только там её ищет окно) и печатает
+// наибольшую погрешность по каждому выходу относительно точного решения.
+// Погрешности хранятся в заголовке файла. Путь можно передать после
+// --build-table, но тогда файл нужно самому положить рядом с программой.
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace table {
+
+const int kMaxChannels = 3;
+const int kProbe = 8;
+
+// Бит статуса "точка вне таблицы"; не пересекается с битами задач.
+const unsigned kOutside = 1u << 31;
+
+struct Axis {
+    double min, max;
+    int count;
+};
+
+// Точное решение в безразмерных переменных u, v -> out[channels].
+typedef void (*ExactKernel)(double u, double v, double *out);
+
+// Переводит хранимые каналы в показываемые значения, если таблица хранит
+// более гладкую функцию ответа; погрешность считается после перевода.
+typedef void (*Decode)(double *out);
+
+struct Spec {
+    const char *name;
+    Axis u, v;
+    int channels;
+    const char *channelNames[kMaxChannels];
+    ExactKernel exact;
+    Decode decode;
+};
+
+struct Header {
+    char magic[8];
+    int32_t nu, nv, channels, reserved;
+    double umin, umax, vmin, vmax;
+    double maxAbsError[kMaxChannels];
+    double maxRelError[kMaxChannels];    // к наибольшему |значению| в таблице
+};
+
+class Table {
+public:
+    Table() : header_(nullptr), data_(nullptr) {}
+
+    bool load(const QString &path) {
+        file_.setFileName(path);
+        if (!file_.open(QIODevice::ReadOnly)) return false;
+        uchar *map = file_.size() >= qint64(sizeof(Header)) ? file_.map(0, file_.size()) : nullptr;
+        if (!map) {
+            file_.close();
+            return false;
+        }
+        const Header *h = reinterpret_cast<const Header *>(map);
+        qint64 expected = qint64(sizeof(Header))
+                        + qint64(h->nu) * h->nv * h->channels * qint64(sizeof(double));
+        if (std::memcmp(h->magic, "TABLE02", 8) || h->nu < 2 || h->nv < 1
+            || h->channels < 1 || h->channels > kMaxChannels || file_.size() != expected) {
+            // Отвергнутый файл не держим открытым: его можно сразу пересобрать.
+            file_.unmap(map);
+            file_.close();
+            return false;
+        }
+        header_ = h;
+        data_ = reinterpret_cast<const double *>(map + sizeof(Header));
+        su_ = (h->nu - 1) / (h->umax - h->umin);
+        sv_ = h->nv > 1 ? (h->nv - 1) / (h->vmax - h->vmin) : 0.0;
+        return true;
+    }
+
+    bool loaded() const { return header_ != nullptr; }
+    const Header &header() const { return *header_; }
+
+    // Билинейная интерполяция; false, если (u, v) вне таблицы.
+    bool lookup(double u, double v, double *out) const {
+        const Header &h = *header_;
+        double fu = (u - h.umin) * su_;
+        double fv = (v - h.vmin) * sv_;
+        if (!(fu >= 0 && fu <= h.nu - 1 && fv >= 0 && fv <= h.nv - 1))
+            return false;
+        int iu = std::min(int(fu), h.nu - 2);
+        int iv = std::min(int(fv), std::max(h.nv - 2, 0));
+        double tu = fu - iu;
+        double tv = fv - iv;
+        const int stride = h.nv > 1 ? h.channels : 0;
+        const double *p00 = data_ + (std::size_t(iu) * h.nv + iv) * h.channels;
+        const double *p10 = p00 + std::size_t(h.nv) * h.channels;
+        for (int c = 0; c < h.channels; ++c) {
+            double a = p00[c] + (p00[c + stride] - p00[c]) * tv;
+            double b = p10[c] + (p10[c + stride] - p10[c]) * tv;
+            out[c] = a + (b - a) * tu;
+        }
+        return true;
+    }
+
+private:
+    QFile file_;
+    const Header *header_;
+    const double *data_;
+    double su_, sv_;
+};
+
+inline bool requested(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--build-table")) return true;
+    }
+    return false;
+}
+
+inline QString defaultPath(const Spec &spec) {
+    return QCoreApplication::applicationDirPath() + "/" + spec.name + ".table";
+}
+
+inline double at(const Axis &a, double i) {
+    return a.count > 1 ? a.min + (a.max - a.min) * (i / (a.count - 1)) : a.min;
+}
+
+// Вызывает body(i) для i из [0, n) в нескольких потоках.
+template <class Body>
+void parallelFor(int n, Body body) {
+    int threads = std::max(1, std::min(QThread::idealThreadCount(), n));
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([=] {
+            for (int i = t; i < n; i += threads) body(i);
+        });
+    }
+    for (std::thread &th : pool) th.join();
+}
+
+inline int build(const Spec &spec, const QString &path) {
+    const int nu = spec.u.count, nv = spec.v.count, nc = spec.channels;
+    std::vector<double> data(std::size_t(nu) * nv * nc);
+    parallelFor(nu, [&](int i) {
+        for (int j = 0; j < nv; ++j)
+            spec.exact(at(spec.u, i), at(spec.v, j), &data[(std::size_t(i) * nv + j) * nc]);
+    });
+
+    Header h;
+    std::memset(&h, 0, sizeof h);
+    std::memcpy(h.magic, "TABLE02", 8);
+    h.nu = nu;
+    h.nv = nv;
+    h.channels = nc;
+    h.umin = spec.u.min;
+    h.umax = spec.u.max;
+    h.vmin = spec.v.min;
+    h.vmax = spec.v.max;
+
+    double scale[kMaxChannels] = {};
+    for (std::size_t i = 0; i < data.size(); i += nc) {
+        double y[kMaxChannels];
+        std::copy(&data[i], &data[i] + nc, y);
+        if (spec.decode) spec.decode(y);
+        for (int c = 0; c < nc; ++c) {
+            if (std::isfinite(y[c])) scale[c] = std::max(scale[c], std::fabs(y[c]));
+        }
+    }
+
+    QFile file(path);
+    auto fail = [&] {
+        std::fprintf(stderr, "%s: не удалось записать %s\n", spec.name, path.toLocal8Bit().constData());
+        file.close();
+        QFile::remove(path);
+        return 1;
+    };
+    const qint64 bytes = qint64(data.size() * sizeof(double));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(reinterpret_cast<const char *>(&h), sizeof h) != qint64(sizeof h)
+        || file.write(reinterpret_cast<const char *>(data.data()), bytes) != bytes
+        || !file.flush())
+        return fail();
+    file.close();
+
+    // Погрешность проверяется на сетке kProbe x kProbe точек внутри каждой
+    // ячейки, а не только в серединах: после decode ошибка бывает
+    // наибольшей не в середине. Каждая строка ячеек считается в своём потоке.
+    {
+        Table table;
+        if (!table.load(path)) return fail();
+        const int cu = nu - 1, cv = std::max(nv - 1, 1);
+        const int pv = nv > 1 ? kProbe : 1;
+        std::vector<double> absErr(std::size_t(cu) * nc, 0.0);
+        parallelFor(cu, [&](int i) {
+            double exact[kMaxChannels], approx[kMaxChannels];
+            double *absRow = &absErr[std::size_t(i) * nc];
+            for (int j = 0; j < cv; ++j) {
+                for (int a = 0; a < kProbe; ++a) {
+                    for (int b = 0; b < pv; ++b) {
+                        double u = at(spec.u, i + (a + 0.5) / kProbe);
+                        double v = at(spec.v, j + (b + 0.5) / pv);
+                        spec.exact(u, v, exact);
+                        table.lookup(u, v, approx);
+                        if (spec.decode) {
+                            spec.decode(exact);
+                            spec.decode(approx);
+                        }
+                        for (int c = 0; c < nc; ++c) {
+                            double e = std::fabs(approx[c] - exact[c]);
+                            absRow[c] = std::max(absRow[c], e);
+                        }
+                    }
+                }
+            }
+        });
+        for (int i = 0; i < cu; ++i) {
+            for (int c = 0; c < nc; ++c)
+                h.maxAbsError[c] = std::max(h.maxAbsError[c], absErr[std::size_t(i) * nc + c]);
+        }
+        for (int c = 0; c < nc; ++c)
+            h.maxRelError[c] = h.maxAbsError[c] / scale[c];
+    }
+
+    // Пока заголовок с погрешностями не записан, файл не оставляется:
+    // иначе окно загрузило бы таблицу с нулевыми погрешностями.
+    if (!file.open(QIODevice::ReadWrite)
+        || file.write(reinterpret_cast<const char *>(&h), sizeof h) != qint64(sizeof h)
+        || !file.flush())
+        return fail();
+    file.close();
+
+    std::printf("%s: %d x %d узлов, %lld байт\n", spec.name, nu, nv,
+                static_cast<long long>(sizeof h + data.size() * sizeof(double)));
+    for (int c = 0; c < nc; ++c)
+        std::printf("  %-8s наибольшая погрешность: абс. %.3g, отн. %.3g\n",
+                    spec.channelNames[c], h.maxAbsError[c], h.maxRelError[c]);
+    return 0;
+}
+
+inline int run(const Spec &spec, const QStringList &args) {
+    QString path = defaultPath(spec);
+    int i = args.indexOf("--build-table");
+    if (i + 1 < args.size()) path = args[i + 1];
+    return build(spec, path);
+}
+
+} // namespace table
+
+#endif // TABLE_H
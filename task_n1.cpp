@@ -9,6 +9,70 @@
 #include <QDoubleValidator>
 #include <cmath>
 
+#include "table.h"
+#include "trace.h"
+#include "validation.h"
+
+enum Status : unsigned {
+    StatusOk = 0,
+    StatusNonPositive = 1u << 0,
+};
+
+static const char *const statusMessages[] = {
+    "Все величины должны быть положительными",
+};
+
+struct Input {
+    double M, m, l, alpha_deg;
+};
+
+struct Result {
+    double V, ratio;
+};
+
+inline Status check(const Input &in) {
+    return Status(unsigned(!((in.M > 0) & (in.m > 0) & (in.l > 0) & (in.alpha_deg > 0))) * StatusNonPositive);
+}
+
+inline Status solve(const Input &in, Result &out) {
+    double M = in.M;
+    double m = in.m;
+
+    double alpha_rad = in.alpha_deg * M_PI / 180.0;
+
+    double numerator = 2 * m * m * 9.81 * in.l * (1 - cos(alpha_rad));
+    double denominator = M * (M + m);
+    double V = sqrt(std::max(numerator / denominator, 0.0));
+
+    out.V = V;
+    out.ratio = (V < 1e-6) ? 0 : m / M;
+
+    return check(in);
+}
+
+// Таблица по u = lg(m/M) и v = α при M = 1, l = 1: V растёт как √l.
+static void solveNormalized(double u, double v, double *out) {
+    Result r;
+    solve({1.0, pow(10.0, u), 1.0, v}, r);
+    out[0] = r.V;
+}
+
+static const table::Spec tableSpec = {
+    "task_n1",
+    {-3.0, 3.0, 601}, {0.0, 180.0, 721},
+    1, {"V"},
+    solveNormalized,
+    nullptr,
+};
+
+inline Status approximate(const table::Table &t, const Input &in, Result &out) {
+    double y[1];
+    if (!t.lookup(log10(in.m / in.M), in.alpha_deg, y)) return Status(table::kOutside);
+    out.V = y[0] * sqrt(in.l);
+    out.ratio = (out.V < 1e-6) ? 0 : in.m / in.M;
+    return check(in);
+}
+
 class PhysicsSolver : public QWidget {
     Q_OBJECT
 public:
@@ -55,6 +119,10 @@ public:
             "}"
             );
         connect(calculateButton, &QPushButton::clicked, this, &PhysicsSolver::calculate);
+        if (approxTable.load(table::defaultPath(tableSpec))) {
+            for (QLineEdit *input : {MInput, mInput, lInput, alphaInput})
+                connect(input, &QLineEdit::textEdited, this, &PhysicsSolver::preview);
+        }
 
         velocityLabel = new QLabel("Скорость тележки (V): ");
         ratioLabel = new QLabel("Соотношение масс для остановки (m/M): ");
@@ -74,33 +142,59 @@ public:
 
 private slots:
     void calculate() {
-        try {
-            double M = MInput->text().toDouble();
-            double m = mInput->text().toDouble();
-            double l = lInput->text().toDouble();
-            double alpha_deg = alphaInput->text().toDouble();
+        Status status = evaluate();
+        if (status != StatusOk) {
+            TRACE_COUNT("invalid_input");
+            QMessageBox::warning(this, "Ошибка", validation::message(status, statusMessages));
+        }
+    }
 
-            if (M <= 0 || m <= 0 || l <= 0 || alpha_deg <= 0) {
-                throw std::invalid_argument("Все величины должны быть положительными");
-            }
+    void preview() {
+        TRACE_SPAN(span, "preview");
+        Result r;
+        if (approximate(approxTable, readInput(), r) == StatusOk)
+            showResult(r, "≈");
+        else
+            clearResult();
+    }
 
-            double alpha_rad = alpha_deg * M_PI / 180.0;
+private:
+    table::Table approxTable;
+
+    Input readInput() const {
+        Input in;
+        in.M = MInput->text().toDouble();
+        in.m = mInput->text().toDouble();
+        in.l = lInput->text().toDouble();
+        in.alpha_deg = alphaInput->text().toDouble();
+        return in;
+    }
 
-            double numerator = 2 * m * m * 9.81 * l * (1 - cos(alpha_rad));
-            double denominator = M * (M + m);
-            double V = sqrt(numerator / denominator);
+    void showResult(const Result &r, const QString &prefix) {
+        velocityLabel->setText(QString("<b>Скорость тележки (V):</b> %1%2 м/с").arg(prefix).arg(r.V, 0, 'f', 4));
+        ratioLabel->setText(QString("<b>Соотношение масс для остановки (m/M):</b> %1%2").arg(prefix).arg(r.ratio, 0, 'f', 2));
+    }
 
-            double ratio = (V < 1e-6) ? 0 : m / M;
+    void clearResult() {
+        velocityLabel->setText("<b>Скорость тележки (V):</b> —");
+        ratioLabel->setText("<b>Соотношение масс для остановки (m/M):</b> —");
+    }
 
-            velocityLabel->setText(QString("<b>Скорость тележки (V):</b> %1 м/с").arg(V, 0, 'f', 4));
-            ratioLabel->setText(QString("<b>Соотношение масс для остановки (m/M):</b> %1").arg(ratio, 0, 'f', 2));
+    Status evaluate() {
+        TRACE_SPAN(total, "calculate");
+        TRACE_SPAN(phase, "parse");
+        Input in = readInput();
 
-        } catch (const std::exception &e) {
-            QMessageBox::warning(this, "Ошибка", e.what());
-        }
+        TRACE_NEXT(phase, "math");
+        Result r;
+        Status status = solve(in, r);
+        if (status != StatusOk) return status;
+
+        TRACE_NEXT(phase, "format");
+        showResult(r, "");
+        return StatusOk;
     }
 
-private:
     QLineEdit *createInputField(const QString &placeholder) {
         QLineEdit *input = new QLineEdit;
         input->setPlaceholderText(placeholder);
@@ -117,12 +211,21 @@ private:
 };
 
 int main(int argc, char *argv[]) {
+    if (table::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return table::run(tableSpec, app.arguments());
+    }
+
     QApplication app(argc, argv);
 
     PhysicsSolver solver;
     solver.show();
 
-    return app.exec();
+    int rc = app.exec();
+
+    TRACE_DUMP("task_n1");
+
+    return rc;
 }
 
 #include "main.moc"
@@ -9,6 +9,35 @@
 #include <QDoubleValidator>
 #include <cmath>
 
+#include "trace.h"
+#include "validation.h"
+
+enum Status : unsigned {
+    StatusOk = 0,
+    StatusNonPositive = 1u << 0,
+};
+
+static const char *const statusMessages[] = {
+    "Все величины должны быть положительными",
+};
+
+struct Input {
+    double M, m, v0, mu;
+};
+
+struct Result {
+    double u, S;
+};
+
+inline Status solve(const Input &in, Result &out) {
+    double u = (in.m * in.v0) / (in.M + in.m);
+
+    out.u = u;
+    out.S = (u * u) / (2 * in.mu * 9.81);
+
+    return Status(unsigned(!((in.M > 0) & (in.m > 0) & (in.v0 > 0) & (in.mu > 0))) * StatusNonPositive);
+}
+
 class PhysicsSolver : public QWidget {
     Q_OBJECT
 public:
@@ -72,29 +101,34 @@ public:
 
 private slots:
     void calculate() {
-        try {
-            double M = MInput->text().toDouble();
-            double m = mInput->text().toDouble();
-            double v0 = v0Input->text().toDouble();
-            double mu = muInput->text().toDouble();
-
-            if (M <= 0 || m <= 0 || v0 <= 0 || mu <= 0) {
-                throw std::invalid_argument("Все величины должны быть положительными");
-            }
-
-            double u = (m * v0) / (M + m);
-
-            double S = (u * u) / (2 * mu * 9.81);
-
-            velocityLabel->setText(QString("<b>Скорость после удара (u):</b> %1 м/с").arg(u, 0, 'f', 3));
-            distanceLabel->setText(QString("<b>Путь до остановки (S):</b> %1 м").arg(S, 0, 'f', 3));
-
-        } catch (const std::exception &e) {
-            QMessageBox::warning(this, "Ошибка", e.what());
+        Status status = evaluate();
+        if (status != StatusOk) {
+            TRACE_COUNT("invalid_input");
+            QMessageBox::warning(this, "Ошибка", validation::message(status, statusMessages));
         }
     }
 
 private:
+    Status evaluate() {
+        TRACE_SPAN(total, "calculate");
+        TRACE_SPAN(phase, "parse");
+        Input in;
+        in.M = MInput->text().toDouble();
+        in.m = mInput->text().toDouble();
+        in.v0 = v0Input->text().toDouble();
+        in.mu = muInput->text().toDouble();
+
+        TRACE_NEXT(phase, "math");
+        Result r;
+        Status status = solve(in, r);
+        if (status != StatusOk) return status;
+
+        TRACE_NEXT(phase, "format");
+        velocityLabel->setText(QString("<b>Скорость после удара (u):</b> %1 м/с").arg(r.u, 0, 'f', 3));
+        distanceLabel->setText(QString("<b>Путь до остановки (S):</b> %1 м").arg(r.S, 0, 'f', 3));
+        return StatusOk;
+    }
+
     QLineEdit *createInputField(const QString &placeholder) {
         QLineEdit *input = new QLineEdit;
         input->setPlaceholderText(placeholder);
@@ -114,7 +148,9 @@ int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
     PhysicsSolver solver;
     solver.show();
-    return app.exec();
+    int rc = app.exec();
+    TRACE_DUMP("task_n2");
+    return rc;
 }
 
 #include "main.moc"
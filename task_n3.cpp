@@ -9,6 +9,139 @@
 #include <QDoubleValidator>
 #include <cmath>
 
+#include "sweep.h"
+#include "table.h"
+#include "trace.h"
+#include "validation.h"
+
+enum Status : unsigned {
+    StatusOk = 0,
+    StatusBadM1 = 1u << 0,
+    StatusBadM2 = 1u << 1,
+    StatusBadL = 1u << 2,
+    StatusBadTheta = 1u << 3,
+    StatusNoSlack = 1u << 4,
+};
+
+static const char *const statusMessages[] = {
+    "Некорректное значение для масса m₁",
+    "Некорректное значение для масса m₂",
+    "Некорректное значение для длина нити L",
+    "Угол θ должен быть в диапазоне: 0° < θ < 90°",
+    "Нить не провиснет при данных параметрах",
+};
+
+struct Input {
+    double m1, m2, L, theta_deg;
+};
+
+struct Result {
+    double v2, phi, h;
+};
+
+inline Status check(const Input &in, double cos_phi) {
+    return Status(unsigned(!(in.m1 > 0)) * StatusBadM1
+                | unsigned(!(in.m2 > 0)) * StatusBadM2
+                | unsigned(!(in.L > 0)) * StatusBadL
+                | unsigned(!((in.theta_deg > 0) & (in.theta_deg < 90))) * StatusBadTheta
+                | unsigned(!(cos_phi < 1.0)) * StatusNoSlack);
+}
+
+inline Status solve(const Input &in, Result &out) {
+    double theta = in.theta_deg * M_PI / 180.0;
+    double v1 = sqrt(std::max(2 * 9.81 * in.L * (1 - cos(theta)), 0.0));
+    double v2 = (2 * in.m1) / (in.m1 + in.m2) * v1;
+
+    double cos_phi = v2*v2 / (9.81 * in.L);
+    double phi = acos(cos_phi) * 180.0 / M_PI;
+
+    double u1 = (in.m1 - in.m2)/(in.m1 + in.m2) * v1;
+    double h = u1*u1 / (2 * 9.81);
+
+    out.v2 = v2;
+    out.phi = phi;
+    out.h = h;
+
+    return check(in, cos_phi);
+}
+
+// Проверка упругого удара по ответам v₂ и h: |u₁| = √(2gh), и должны
+// сохраняться импульс m₁v₁ = m₁u₁ + m₂v₂ и энергия m₁v₁² = m₁u₁² + m₂v₂².
+// u₁² = 2gh подставляется в энергию без корня. v₁² = 2gL(1 - cos θ)
+// берётся из входных данных, а не из solve, чтобы ошибка в v₁ была видна.
+inline void collisionDrift(const Input &in, const Result &r, double *drift) {
+    double m1 = in.m1, m2 = in.m2, v2 = r.v2;
+    double v1sq = 2 * 9.81 * in.L * (1 - cos(in.theta_deg * M_PI / 180.0));
+    double u1 = copysign(sqrt(2 * 9.81 * r.h), m1 - m2);
+    double p = m1 * sqrt(std::max(v1sq, 0.0));
+    double E = m1 * v1sq;
+    drift[0] = (m1 * u1 + m2 * v2 - p) / p;
+    drift[1] = (m1 * 2 * 9.81 * r.h + m2 * v2 * v2 - E) / E;
+}
+
+static void solveBlock(const double *in, double *out, unsigned *status, double *drift, int n) {
+    for (int i = 0; i < n; ++i) {
+        Input x = {in[4*i], in[4*i+1], in[4*i+2], in[4*i+3]};
+        Result r;
+        status[i] = solve(x, r);
+        out[3*i] = r.v2;
+        out[3*i+1] = r.phi;
+        out[3*i+2] = r.h;
+        collisionDrift(x, r, &drift[2*i]);
+    }
+}
+
+static const sweep::Task sweepTask = {
+    "task_n3",
+    4, {"m1", "m2", "L", "theta"},
+    3, {"v2", "phi", "h"},
+    statusMessages, sizeof statusMessages / sizeof statusMessages[0],
+    solveBlock,
+    2, {"momentum", "energy"},
+};
+
+// Таблица по u = lg(m₂/m₁) и v = θ при m₁ = 1, L = 1: v₂ растёт как √L,
+// h - как L, а φ от L не зависит. У самого φ на границе провисания
+// бесконечная производная, поэтому хранится w = arccos²(cos φ), за
+// границей продолженное как -arch²(cos φ): это гладкая функция cos φ,
+// и φ = √w восстанавливается уже после интерполяции.
+static void solveNormalized(double u, double v, double *out) {
+    Result r;
+    solve({1.0, pow(10.0, u), 1.0, v}, r);
+    double cos_phi = r.v2 * r.v2 / 9.81;
+    double w = cos_phi <= 1.0 ? acos(cos_phi) : acosh(cos_phi);
+    out[0] = r.v2;
+    out[1] = cos_phi <= 1.0 ? w * w : -w * w;
+    out[2] = r.h;
+}
+
+static void decodeNormalized(double *y) {
+    y[1] = sqrt(std::max(y[1], 0.0)) * 180.0 / M_PI;
+}
+
+static const table::Spec tableSpec = {
+    "task_n3",
+    {-3.0, 3.0, 601}, {0.0, 90.0, 361},
+    3, {"v2", "phi", "h"},
+    solveNormalized,
+    decodeNormalized,
+};
+
+// Граница провисания проверяется по точной формуле
+// cos φ = v₂²/(gL) = (2m₁/(m₁ + m₂))² · 2(1 - cos θ), а не по таблице:
+// иначе вблизи границы приближённый ответ пропускал бы ввод, который
+// точный расчёт отвергает.
+inline Status approximate(const table::Table &t, const Input &in, Result &out) {
+    double y[3];
+    if (!t.lookup(log10(in.m2 / in.m1), in.theta_deg, y)) return Status(table::kOutside);
+    decodeNormalized(y);
+    out.v2 = y[0] * sqrt(in.L);
+    out.phi = y[1];
+    out.h = y[2] * in.L;
+    double k = 2 * in.m1 / (in.m1 + in.m2);
+    return check(in, k * k * 2 * (1 - cos(in.theta_deg * M_PI / 180.0)));
+}
+
 class PendulumCollision : public QWidget {
     Q_OBJECT
 public:
@@ -57,6 +190,10 @@ public:
             "}"
             );
         connect(calculateButton, &QPushButton::clicked, this, &PendulumCollision::calculate);
+        if (approxTable.load(table::defaultPath(tableSpec))) {
+            for (QLineEdit *input : {m1Input, m2Input, LInput, thetaInput})
+                connect(input, &QLineEdit::textEdited, this, &PendulumCollision::preview);
+        }
 
         QLabel *resultsHeader = new QLabel("<h3 style='color: #2c3e50; margin-top: 15px;'>Результаты расчета:</h3>");
 
@@ -83,35 +220,63 @@ public:
 
 private slots:
     void calculate() {
-        try {
-            double m1 = getPositiveValue(m1Input, "масса m₁");
-            double m2 = getPositiveValue(m2Input, "масса m₂");
-            double L = getPositiveValue(LInput, "длина нити L");
-            double theta_deg = getAngleValue(thetaInput);
+        Status status = evaluate();
+        if (status != StatusOk) {
+            TRACE_COUNT("invalid_input");
+            QMessageBox::warning(this, "Ошибка расчета", validation::message(status, statusMessages));
+        }
+    }
 
-            double theta = theta_deg * M_PI / 180.0;
-            double v1 = sqrt(2 * 9.81 * L * (1 - cos(theta)));
-            double v2 = (2 * m1) / (m1 + m2) * v1;
+    void preview() {
+        TRACE_SPAN(span, "preview");
+        Result r;
+        if (approximate(approxTable, readInput(), r) == StatusOk)
+            showResult(r, "≈");
+        else
+            clearResult();
+    }
 
-            double cos_phi = v2*v2 / (9.81 * L);
-            if (cos_phi >= 1.0) throw std::runtime_error("Нить не провиснет при данных параметрах");
-            double phi = acos(cos_phi) * 180.0 / M_PI;
+private:
+    QLineEdit *m1Input, *m2Input, *LInput, *thetaInput;
+    QLabel *v2Label, *phiLabel, *hLabel;
 
-            double u1 = (m1 - m2)/(m1 + m2) * v1;
-            double h = u1*u1 / (2 * 9.81);
+    table::Table approxTable;
 
-            v2Label->setText(QString("Скорость v₂: <b>%1 м/с</b>").arg(v2, 0, 'f', 3));
-            phiLabel->setText(QString("Угол провисания φ: <b>%1°</b>").arg(phi, 0, 'f', 2));
-            hLabel->setText(QString("Высота подъема h: <b>%1 м</b>").arg(h, 0, 'f', 3));
+    Input readInput() const {
+        Input in;
+        in.m1 = m1Input->text().toDouble();
+        in.m2 = m2Input->text().toDouble();
+        in.L = LInput->text().toDouble();
+        in.theta_deg = thetaInput->text().toDouble();
+        return in;
+    }
 
-        } catch (const std::exception &e) {
-            QMessageBox::warning(this, "Ошибка расчета", e.what());
-        }
+    void showResult(const Result &r, const QString &prefix) {
+        v2Label->setText(QString("Скорость v₂: <b>%1%2 м/с</b>").arg(prefix).arg(r.v2, 0, 'f', 3));
+        phiLabel->setText(QString("Угол провисания φ: <b>%1%2°</b>").arg(prefix).arg(r.phi, 0, 'f', 2));
+        hLabel->setText(QString("Высота подъема h: <b>%1%2 м</b>").arg(prefix).arg(r.h, 0, 'f', 3));
     }
 
-private:
-    QLineEdit *m1Input, *m2Input, *LInput, *thetaInput;
-    QLabel *v2Label, *phiLabel, *hLabel;
+    void clearResult() {
+        v2Label->setText("Скорость v₂: <b>—</b>");
+        phiLabel->setText("Угол провисания φ: <b>—</b>");
+        hLabel->setText("Высота подъема h: <b>—</b>");
+    }
+
+    Status evaluate() {
+        TRACE_SPAN(total, "calculate");
+        TRACE_SPAN(phase, "parse");
+        Input in = readInput();
+
+        TRACE_NEXT(phase, "math");
+        Result r;
+        Status status = solve(in, r);
+        if (status != StatusOk) return status;
+
+        TRACE_NEXT(phase, "format");
+        showResult(r, "");
+        return StatusOk;
+    }
 
     QLineEdit* createInputField(const QString& placeholder) {
         QLineEdit* input = new QLineEdit;
@@ -139,33 +304,28 @@ private:
             );
         return label;
     }
+};
 
-    double getPositiveValue(QLineEdit* input, const QString& name) {
-        bool ok;
-        double value = input->text().toDouble(&ok);
-        if (!ok || value <= 0) {
-            throw std::invalid_argument(QString("Некорректное значение для %1").arg(name).toStdString());
-        }
-        return value;
+int main(int argc, char *argv[]) {
+    if (table::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return table::run(tableSpec, app.arguments());
     }
-
-    double getAngleValue(QLineEdit* input) {
-        bool ok;
-        double angle = input->text().toDouble(&ok);
-        if (!ok || angle <= 0 || angle >= 90) {
-            throw std::invalid_argument("Угол θ должен быть в диапазоне: 0° < θ < 90°");
-        }
-        return angle;
+    if (sweep::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return sweep::run(sweepTask, app.arguments());
     }
-};
 
-int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
 
     PendulumCollision solver;
     solver.show();
 
-    return app.exec();
+    int rc = app.exec();
+
+    TRACE_DUMP("task_n3");
+
+    return rc;
 }
 
 #include "main.moc"
@@ -9,6 +9,126 @@
 #include <QDoubleValidator>
 #include <cmath>
 
+#include "sweep.h"
+#include "table.h"
+#include "trace.h"
+#include "validation.h"
+
+enum Status : unsigned {
+    StatusOk = 0,
+    StatusBadM = 1u << 0,
+    StatusBadMass = 1u << 1,
+    StatusBadAlpha = 1u << 2,
+    StatusBadH = 1u << 3,
+};
+
+static const char *const statusMessages[] = {
+    "Некорректное значение для масса клина M",
+    "Некорректное значение для масса бруска m",
+    "Угол α должен быть: 0° < α < 90°",
+    "Некорректное значение для высота клина H",
+};
+
+struct Input {
+    double M, m, alpha_deg, H;
+};
+
+struct Result {
+    double V, h, t;
+};
+
+inline Status check(const Input &in) {
+    return Status(unsigned(!(in.M > 0)) * StatusBadM
+                | unsigned(!(in.m > 0)) * StatusBadMass
+                | unsigned(!((in.alpha_deg > 0) & (in.alpha_deg < 90))) * StatusBadAlpha
+                | unsigned(!(in.H > 0)) * StatusBadH);
+}
+
+// cos α нужен и проверке импульса в solveBlock, поэтому solve его отдаёт.
+inline Status solve(const Input &in, Result &out, double &cos_a) {
+    double M = in.M;
+    double m = in.m;
+    double H = in.H;
+
+    double alpha = in.alpha_deg * M_PI / 180.0;
+    double sin_a = sin(alpha);
+    cos_a = cos(alpha);
+
+    out.V = sqrt(std::max(2*m*m*9.81*H*cos_a*cos_a/((M + m)*(M + m*sin_a*sin_a)), 0.0));
+
+    out.h = H * pow((M - m*sin_a*sin_a)/(M + m*sin_a*sin_a), 2);
+
+    out.t = 2*sqrt(std::max(2*H/(9.81*sin_a), 0.0))*(1 + (M + m*sin_a*sin_a)/M);
+
+    return check(in);
+}
+
+inline Status solve(const Input &in, Result &out) {
+    double cos_a;
+    return solve(in, out, cos_a);
+}
+
+// Горизонтальный импульс в момент достижения основания: из
+// (M + m)V = m u cos α берётся скорость бруска относительно клина u и
+// подставляется в энергию mgH = ½MV² + ½m((V - u cos α)² + (u sin α)²).
+// После упрощения (sin²α = 1 - cos²α) остаётся одно деление и ни одного
+// корня: уход = V²(M + m)(M + m - m cos²α) / (2gHm² cos²α) - 1.
+inline double momentumDrift(const Input &in, const Result &r, double cos_a) {
+    double M = in.M, m = in.m, V = r.V;
+    double c2 = cos_a * cos_a;
+    return V*V*(M + m)*(M + m - m*c2) / (2*9.81*in.H*m*m*c2) - 1;
+}
+
+static void solveBlock(const double *in, double *out, unsigned *status, double *drift, int n) {
+    for (int i = 0; i < n; ++i) {
+        Input x = {in[4*i], in[4*i+1], in[4*i+2], in[4*i+3]};
+        Result r;
+        double cos_a;
+        status[i] = solve(x, r, cos_a);
+        out[3*i] = r.V;
+        out[3*i+1] = r.h;
+        out[3*i+2] = r.t;
+        drift[i] = momentumDrift(x, r, cos_a);
+    }
+}
+
+static const sweep::Task sweepTask = {
+    "task_n4",
+    4, {"M", "m", "alpha", "H"},
+    3, {"V", "h", "t"},
+    statusMessages, sizeof statusMessages / sizeof statusMessages[0],
+    solveBlock,
+    1, {"momentum"},
+};
+
+// Таблица по u = lg(m/M) и v = α при M = 1, H = 1: V и t растут как √H,
+// h - как H.
+static void solveNormalized(double u, double v, double *out) {
+    Result r;
+    solve({1.0, pow(10.0, u), v, 1.0}, r);
+    out[0] = r.V;
+    out[1] = r.h;
+    out[2] = r.t;
+}
+
+static const table::Spec tableSpec = {
+    "task_n4",
+    {-3.0, 3.0, 601}, {0.5, 89.5, 357},
+    3, {"V", "h", "t"},
+    solveNormalized,
+    nullptr,
+};
+
+inline Status approximate(const table::Table &t, const Input &in, Result &out) {
+    double y[3];
+    if (!t.lookup(log10(in.m / in.M), in.alpha_deg, y)) return Status(table::kOutside);
+    double scale = sqrt(in.H);
+    out.V = y[0] * scale;
+    out.h = y[1] * in.H;
+    out.t = y[2] * scale;
+    return check(in);
+}
+
 class WedgeProblem : public QWidget {
     Q_OBJECT
 public:
@@ -28,7 +148,6 @@ public:
             );
         problemLabel->setWordWrap(true);
 
-
         MInput = createInputField("Масса клина M (кг):");
         mInput = createInputField("Масса бруска m (кг):");
         alphaInput = createInputField("Угол наклона α (град):");
@@ -49,7 +168,10 @@ public:
             "}"
             );
         connect(calculateButton, &QPushButton::clicked, this, &WedgeProblem::calculate);
-
+        if (approxTable.load(table::defaultPath(tableSpec))) {
+            for (QLineEdit *input : {MInput, mInput, alphaInput, HInput})
+                connect(input, &QLineEdit::textEdited, this, &WedgeProblem::preview);
+        }
 
         QLabel *resultsHeader = new QLabel("<h3 style='color: #2c3e50; margin-top: 15px;'>Результаты:</h3>");
         velocityLabel = createResultLabel("Скорость клина V:");
@@ -83,34 +205,63 @@ public:
 
 private slots:
     void calculate() {
-        try {
-            double M = getPositiveValue(MInput, "масса клина M");
-            double m = getPositiveValue(mInput, "масса бруска m");
-            double alpha_deg = getAngleValue(alphaInput);
-            double H = getPositiveValue(HInput, "высота клина H");
+        Status status = evaluate();
+        if (status != StatusOk) {
+            TRACE_COUNT("invalid_input");
+            QMessageBox::warning(this, "Ошибка", validation::message(status, statusMessages));
+        }
+    }
 
-            double alpha = alpha_deg * M_PI / 180.0;
-            double sin_a = sin(alpha);
-            double cos_a = cos(alpha);
+    void preview() {
+        TRACE_SPAN(span, "preview");
+        Result r;
+        if (approximate(approxTable, readInput(), r) == StatusOk)
+            showResult(r, "≈");
+        else
+            clearResult();
+    }
 
-            double V = sqrt(2*m*m*9.81*H*cos_a*cos_a/((M + m)*(M + m*sin_a*sin_a)));
+private:
+    QLineEdit *MInput, *mInput, *alphaInput, *HInput;
+    QLabel *velocityLabel, *heightLabel, *timeLabel;
 
-            double h = H * pow((M - m*sin_a*sin_a)/(M + m*sin_a*sin_a), 2);
+    table::Table approxTable;
 
-            double t = 2*sqrt(2*H/(9.81*sin_a))*(1 + (M + m*sin_a*sin_a)/M);
+    Input readInput() const {
+        Input in;
+        in.M = MInput->text().toDouble();
+        in.m = mInput->text().toDouble();
+        in.alpha_deg = alphaInput->text().toDouble();
+        in.H = HInput->text().toDouble();
+        return in;
+    }
 
-            velocityLabel->setText(QString("Скорость клина V: <b>%1 м/с</b>").arg(V, 0, 'f', 3));
-            heightLabel->setText(QString("Высота подъема h: <b>%1 м</b>").arg(h, 0, 'f', 3));
-            timeLabel->setText(QString("Полное время t: <b>%1 с</b>").arg(t, 0, 'f', 2));
+    void showResult(const Result &r, const QString &prefix) {
+        velocityLabel->setText(QString("Скорость клина V: <b>%1%2 м/с</b>").arg(prefix).arg(r.V, 0, 'f', 3));
+        heightLabel->setText(QString("Высота подъема h: <b>%1%2 м</b>").arg(prefix).arg(r.h, 0, 'f', 3));
+        timeLabel->setText(QString("Полное время t: <b>%1%2 с</b>").arg(prefix).arg(r.t, 0, 'f', 2));
+    }
 
-        } catch (const std::exception &e) {
-            QMessageBox::warning(this, "Ошибка", e.what());
-        }
+    void clearResult() {
+        velocityLabel->setText("Скорость клина V: <b>—</b>");
+        heightLabel->setText("Высота подъема h: <b>—</b>");
+        timeLabel->setText("Полное время t: <b>—</b>");
     }
 
-private:
-    QLineEdit *MInput, *mInput, *alphaInput, *HInput;
-    QLabel *velocityLabel, *heightLabel, *timeLabel;
+    Status evaluate() {
+        TRACE_SPAN(total, "calculate");
+        TRACE_SPAN(phase, "parse");
+        Input in = readInput();
+
+        TRACE_NEXT(phase, "math");
+        Result r;
+        Status status = solve(in, r);
+        if (status != StatusOk) return status;
+
+        TRACE_NEXT(phase, "format");
+        showResult(r, "");
+        return StatusOk;
+    }
 
     QLineEdit* createInputField(const QString& placeholder) {
         QLineEdit* input = new QLineEdit;
@@ -138,32 +289,24 @@ private:
             );
         return label;
     }
+};
 
-    double getPositiveValue(QLineEdit* input, const QString& name) {
-        bool ok;
-        double value = input->text().toDouble(&ok);
-        if (!ok || value <= 0) {
-            throw std::invalid_argument(QString("Некорректное значение для %1").arg(name).toStdString());
-        }
-        return value;
+int main(int argc, char *argv[]) {
+    if (table::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return table::run(tableSpec, app.arguments());
     }
-
-    double getAngleValue(QLineEdit* input) {
-        bool ok;
-        double angle = input->text().toDouble(&ok);
-        if (!ok || angle <= 0 || angle >= 90) {
-            throw std::invalid_argument("Угол α должен быть: 0° < α < 90°");
-        }
-        return angle;
+    if (sweep::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return sweep::run(sweepTask, app.arguments());
     }
-};
 
-int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
     WedgeProblem solver;
     solver.show();
-    return app.exec();
+    int rc = app.exec();
+    TRACE_DUMP("task_n4");
+    return rc;
 }
 
-
 #include "main.moc"
@@ -9,6 +9,140 @@
 #include <QDoubleValidator>
 #include <cmath>
 
+#include "sweep.h"
+#include "table.h"
+#include "trace.h"
+#include "validation.h"
+
+enum Status : unsigned {
+    StatusOk = 0,
+    StatusBadMass = 1u << 0,
+    StatusBadL = 1u << 1,
+    StatusBadW0 = 1u << 2,
+    StatusBadW = 1u << 3,
+    StatusNotFaster = 1u << 4,
+    StatusNoDeflection = 1u << 5,
+};
+
+static const char *const statusMessages[] = {
+    "m должно быть положительным",
+    "L должно быть положительным",
+    "ω₀ должно быть положительным",
+    "ω должно быть положительным",
+    "ω должна быть > ω₀",
+    "Стержень не отклоняется (ω слишком мала)",
+};
+
+struct Input {
+    double m, L, w0, w;
+};
+
+struct Result {
+    double alpha_deg, T, A;
+};
+
+inline Status check(const Input &in, double cos_alpha) {
+    return Status(unsigned(!(in.m > 0)) * StatusBadMass
+                | unsigned(!(in.L > 0)) * StatusBadL
+                | unsigned(!(in.w0 > 0)) * StatusBadW0
+                | unsigned(!(in.w > 0)) * StatusBadW
+                | unsigned(!(in.w > in.w0)) * StatusNotFaster
+                | unsigned(!(cos_alpha < 1.0)) * StatusNoDeflection);
+}
+
+inline Status solve(const Input &in, Result &out) {
+    double m = in.m;
+    double L = in.L;
+    double w0 = in.w0;
+    double w = in.w;
+
+    double g = 9.81;
+    double cos_alpha = g / (L * w * w);
+    double alpha_rad = std::acos(cos_alpha);
+    out.alpha_deg = alpha_rad * 180.0 / M_PI;
+
+    out.T = m * L * w * w / std::sin(alpha_rad);
+
+    double K0 = 0.5 * m * L * L * w0 * w0;
+    double K = 0.5 * m * L * L * w * w * std::sin(alpha_rad) * std::sin(alpha_rad);
+    double U = m * g * L * (1 - std::cos(alpha_rad));
+    out.A = (K + U) - K0;
+
+    return check(in, cos_alpha);
+}
+
+// Работа по теореме об изменении энергии, записанная через ω без угла:
+// при cos α = g/(Lω²) K + U = ½mL²ω² + mgL - 3mg²/(2ω²), и
+// A = K + U - ½mL²ω₀². Уход отнесён к ½mL²ω² + mgL.
+inline double workDrift(const Input &in, const Result &r) {
+    const double g = 9.81;
+    double m = in.m, L = in.L, w = in.w;
+    double scale = 0.5 * m * L * L * w * w + m * g * L;
+    double expected = scale - 1.5 * m * g * g / (w * w) - 0.5 * m * L * L * in.w0 * in.w0;
+    return (r.A - expected) / scale;
+}
+
+static void solveBlock(const double *in, double *out, unsigned *status, double *drift, int n) {
+    for (int i = 0; i < n; ++i) {
+        Input x = {in[4*i], in[4*i+1], in[4*i+2], in[4*i+3]};
+        Result r;
+        status[i] = solve(x, r);
+        out[3*i] = r.alpha_deg;
+        out[3*i+1] = r.T;
+        out[3*i+2] = r.A;
+        drift[i] = workDrift(x, r);
+    }
+}
+
+static const sweep::Task sweepTask = {
+    "task_n5",
+    4, {"m", "L", "w0", "w"},
+    3, {"alpha", "T", "A"},
+    statusMessages, sizeof statusMessages / sizeof statusMessages[0],
+    solveBlock,
+    1, {"work"},
+};
+
+// Ответ зависит от x = Lω²/g, поэтому таблица одномерная, по u = lg x,
+// при m = 1, L = 1, ω₀ = 0: T растёт как m, энергия K + U - как mL,
+// а K₀ считается отдельно. У α при cos α → 1 (u → 0) бесконечная
+// производная, а T = mLω²/sin α там уходит в бесконечность, поэтому
+// хранятся гладкие α² и T sin α = mLω², и таблица доходит до u = 0.
+static void solveNormalized(double u, double, double *out) {
+    Result r;
+    double w2 = 9.81 * pow(10.0, u);
+    solve({1.0, 1.0, 0.0, sqrt(w2)}, r);
+    double alpha = r.alpha_deg * M_PI / 180.0;
+    out[0] = alpha * alpha;
+    out[1] = w2;
+    out[2] = r.A;
+}
+
+static void decodeNormalized(double *y) {
+    double alpha = sqrt(std::max(y[0], 0.0));
+    y[0] = alpha * 180.0 / M_PI;
+    y[1] /= std::sin(alpha);
+}
+
+static const table::Spec tableSpec = {
+    "task_n5",
+    {0.0, 4.0, 16001}, {0.0, 0.0, 1},
+    3, {"alpha", "T", "K+U"},
+    solveNormalized,
+    decodeNormalized,
+};
+
+inline Status approximate(const table::Table &t, const Input &in, Result &out) {
+    double cos_alpha = 9.81 / (in.L * in.w * in.w);
+    double y[3];
+    if (!t.lookup(-log10(cos_alpha), 0.0, y)) return Status(table::kOutside);
+    decodeNormalized(y);
+    out.alpha_deg = y[0];
+    out.T = in.m * y[1];
+    out.A = in.m * in.L * y[2] - 0.5 * in.m * in.L * in.L * in.w0 * in.w0;
+    return check(in, cos_alpha);
+}
+
 class FlexibleRodSolver : public QWidget {
     Q_OBJECT
 public:
@@ -48,6 +182,10 @@ public:
             "}"
             );
         connect(calculateButton, &QPushButton::clicked, this, &FlexibleRodSolver::calculate);
+        if (approxTable.load(table::defaultPath(tableSpec))) {
+            for (QLineEdit *input : {mInput, LInput, w0Input, wInput})
+                connect(input, &QLineEdit::textEdited, this, &FlexibleRodSolver::preview);
+        }
 
         QLabel *resultsHeader = new QLabel("<h3 style='color: #2c3e50; margin-top: 15px;'>Результаты:</h3>");
         alphaLabel = createResultLabel("Угол отклонения α:");
@@ -81,40 +219,63 @@ public:
 
 private slots:
     void calculate() {
-        try {
-            double m = getPositiveValue(mInput, "m");
-            double L = getPositiveValue(LInput, "L");
-            double w0 = getPositiveValue(w0Input, "ω₀");
-            double w = getPositiveValue(wInput, "ω");
-
-            if (w <= w0) throw std::invalid_argument("ω должна быть > ω₀");
+        Status status = evaluate();
+        if (status != StatusOk) {
+            TRACE_COUNT("invalid_input");
+            QMessageBox::warning(this, "Ошибка", validation::message(status, statusMessages));
+        }
+    }
 
-            double g = 9.81;
-            double cos_alpha = g / (L * w * w);
-            if (cos_alpha >= 1.0) throw std::invalid_argument("Стержень не отклоняется (ω слишком мала)");
-            double alpha_rad = std::acos(cos_alpha);
-            double alpha_deg = alpha_rad * 180.0 / M_PI;
+    void preview() {
+        TRACE_SPAN(span, "preview");
+        Result r;
+        if (approximate(approxTable, readInput(), r) == StatusOk)
+            showResult(r, "≈");
+        else
+            clearResult();
+    }
 
-            double T = m * L * w * w / std::sin(alpha_rad);
+private:
+    QLineEdit *mInput, *LInput, *w0Input, *wInput;
+    QLabel *alphaLabel, *TLabel, *ALabel;
 
-            double K0 = 0.5 * m * L * L * w0 * w0;
-            double K = 0.5 * m * L * L * w * w * std::sin(alpha_rad) * std::sin(alpha_rad);
-            double U = m * g * L * (1 - std::cos(alpha_rad));
-            double A = (K + U) - K0;
+    table::Table approxTable;
 
+    Input readInput() const {
+        Input in;
+        in.m = mInput->text().toDouble();
+        in.L = LInput->text().toDouble();
+        in.w0 = w0Input->text().toDouble();
+        in.w = wInput->text().toDouble();
+        return in;
+    }
 
-            alphaLabel->setText(QString("Угол отклонения α: <b>%1°</b>").arg(alpha_deg, 0, 'f', 2));
-            TLabel->setText(QString("Натяжение T: <b>%1 Н</b>").arg(T, 0, 'f', 3));
-            ALabel->setText(QString("Работа A: <b>%1 Дж</b>").arg(A, 0, 'f', 3));
+    void showResult(const Result &r, const QString &prefix) {
+        alphaLabel->setText(QString("Угол отклонения α: <b>%1%2°</b>").arg(prefix).arg(r.alpha_deg, 0, 'f', 2));
+        TLabel->setText(QString("Натяжение T: <b>%1%2 Н</b>").arg(prefix).arg(r.T, 0, 'f', 3));
+        ALabel->setText(QString("Работа A: <b>%1%2 Дж</b>").arg(prefix).arg(r.A, 0, 'f', 3));
+    }
 
-        } catch (const std::exception &e) {
-            QMessageBox::warning(this, "Ошибка", e.what());
-        }
+    void clearResult() {
+        alphaLabel->setText("Угол отклонения α: <b>—</b>");
+        TLabel->setText("Натяжение T: <b>—</b>");
+        ALabel->setText("Работа A: <b>—</b>");
     }
 
-private:
-    QLineEdit *mInput, *LInput, *w0Input, *wInput;
-    QLabel *alphaLabel, *TLabel, *ALabel;
+    Status evaluate() {
+        TRACE_SPAN(total, "calculate");
+        TRACE_SPAN(phase, "parse");
+        Input in = readInput();
+
+        TRACE_NEXT(phase, "math");
+        Result r;
+        Status status = solve(in, r);
+        if (status != StatusOk) return status;
+
+        TRACE_NEXT(phase, "format");
+        showResult(r, "");
+        return StatusOk;
+    }
 
     QLineEdit* createInputField(const QString& placeholder) {
         QLineEdit* input = new QLineEdit;
@@ -142,22 +303,24 @@ private:
             );
         return label;
     }
-
-    double getPositiveValue(QLineEdit* input, const QString& name) {
-        bool ok;
-        double value = input->text().toDouble(&ok);
-        if (!ok || value <= 0) {
-            throw std::invalid_argument(QString("%1 должно быть положительным").arg(name).toStdString());
-        }
-        return value;
-    }
 };
 
 int main(int argc, char *argv[]) {
+    if (table::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return table::run(tableSpec, app.arguments());
+    }
+    if (sweep::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return sweep::run(sweepTask, app.arguments());
+    }
+
     QApplication app(argc, argv);
     FlexibleRodSolver solver;
     solver.show();
-    return app.exec();
+    int rc = app.exec();
+    TRACE_DUMP("task_n5");
+    return rc;
 }
 
 #include "main.moc"
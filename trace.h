@@ -0,0 +1,249 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Инструментирование горячих путей: вложенные интервалы (spans), счётчики
+// и гистограммы длительностей на поток. Включается флагом PHYSICS_TRACE
+// (DEFINES += PHYSICS_TRACE в .pro), без него все макросы пустые.
+//
+//   TRACE_SPAN(s, "calculate");   // интервал до конца области видимости
+//   TRACE_NEXT(s, "format");      // закрыть текущую фазу и начать следующую
+//   TRACE_COUNT("invalid_input"); // счётчик событий
+//   TRACE_ADD("sweep.rows", n);   // прибавить к счётчику n
+//   TRACE_DUMP("task_n3");        // task_n3.trace.json + task_n3.metrics.txt
+//
+// *.trace.json открывается в chrome://tracing или Perfetto,
+// *.metrics.txt имеет текстовый формат Prometheus.
+//
+// Интервал стоит около 0.1 мкс, почти всё - два чтения steady_clock.
+// В переборе параметров (sweep.h) это 3 интервала на блок из 4096 строк
+// (~0.5 мс), то есть около 0.1%; в calculate() - 4 интервала, около
+// 0.4 мкс на нажатие.
+
+#ifdef PHYSICS_TRACE
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::size_t kMaxEvents = 1 << 20;
+const int kBuckets = 40;
+const int kMaxSpans = 32;
+
+struct Event {
+    const char *name;
+    int64_t beginNs;
+    int64_t durNs;
+};
+
+// Корзина i содержит длительности из [2^i, 2^(i+1)) нс, последняя -
+// все длительности от 2^(kBuckets-1) нс.
+struct Histogram {
+    uint64_t buckets[kBuckets] = {};
+    uint64_t count = 0;
+    int64_t sumNs = 0;
+};
+
+// Гистограмма интервала в плоском массиве потока. Ключ - адрес
+// строкового литерала; различных интервалов единицы, поэтому линейный
+// поиск по нескольким указателям дешевле обхода дерева.
+struct SpanSlot {
+    const char *name = nullptr;
+    Histogram histogram;
+};
+
+struct ThreadState {
+    uint32_t tid = 0;
+    std::vector<Event> events;
+    std::map<const char *, uint64_t> counters;
+    SpanSlot spans[kMaxSpans];
+    int spanCount = 0;
+    uint64_t droppedSpans = 0;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadState>> threads;
+    Clock::time_point origin = Clock::now();
+};
+
+inline Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+// Состояние потока принадлежит реестру и переживает сам поток,
+// поэтому записи не требуют блокировок, а выгрузка видит всё.
+inline ThreadState &local() {
+    thread_local ThreadState *state = nullptr;
+    if (!state) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.emplace_back(new ThreadState);
+        state = r.threads.back().get();
+        state->tid = static_cast<uint32_t>(r.threads.size());
+        state->events.reserve(1024);
+    }
+    return *state;
+}
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now() - registry().origin).count();
+}
+
+inline int bucketOf(int64_t ns) {
+    int i = 0;
+    uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    while (v >>= 1) ++i;
+    return i < kBuckets ? i : kBuckets - 1;
+}
+
+inline Histogram *histogram(ThreadState &t, const char *name) {
+    for (int i = 0; i < t.spanCount; ++i) {
+        if (t.spans[i].name == name) return &t.spans[i].histogram;
+    }
+    if (t.spanCount == kMaxSpans) return nullptr;
+    t.spans[t.spanCount].name = name;
+    return &t.spans[t.spanCount++].histogram;
+}
+
+inline void record(const char *name, int64_t beginNs, int64_t endNs) {
+    ThreadState &t = local();
+    int64_t dur = endNs - beginNs;
+    if (t.events.size() < kMaxEvents)
+        t.events.push_back({name, beginNs, dur});
+    Histogram *h = histogram(t, name);
+    if (!h) {
+        t.droppedSpans++;
+        return;
+    }
+    h->buckets[bucketOf(dur)]++;
+    h->count++;
+    h->sumNs += dur;
+}
+
+inline void count(const char *name, uint64_t n = 1) {
+    local().counters[name] += n;
+}
+
+class Span {
+public:
+    explicit Span(const char *name) : name_(name), begin_(nowNs()) {}
+    ~Span() { record(name_, begin_, nowNs()); }
+
+    void next(const char *name) {
+        int64_t now = nowNs();
+        record(name_, begin_, now);
+        name_ = name;
+        begin_ = now;
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *name_;
+    int64_t begin_;
+};
+
+inline void writeChromeTrace(const std::string &path) {
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) return;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::fputs("{\"traceEvents\":[\n", f);
+    bool first = true;
+    for (const auto &t : r.threads) {
+        for (const Event &e : t->events) {
+            std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                            "\"ts\":%.3f,\"dur\":%.3f}",
+                         first ? "" : ",\n", e.name, t->tid,
+                         e.beginNs / 1000.0, e.durNs / 1000.0);
+            first = false;
+        }
+    }
+    std::fputs("\n]}\n", f);
+    std::fclose(f);
+}
+
+inline void writePrometheus(const std::string &path) {
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) return;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, Histogram> histograms;
+    for (const auto &t : r.threads) {
+        for (const auto &c : t->counters) counters[c.first] += c.second;
+        if (t->droppedSpans) counters["trace_dropped_spans"] += t->droppedSpans;
+        for (int s = 0; s < t->spanCount; ++s) {
+            const SpanSlot &src = t->spans[s];
+            Histogram &dst = histograms[src.name];
+            for (int i = 0; i < kBuckets; ++i) dst.buckets[i] += src.histogram.buckets[i];
+            dst.count += src.histogram.count;
+            dst.sumNs += src.histogram.sumNs;
+        }
+    }
+
+    std::fputs("# TYPE physics_events_total counter\n", f);
+    for (const auto &c : counters)
+        std::fprintf(f, "physics_events_total{name=\"%s\"} %llu\n",
+                     c.first.c_str(), static_cast<unsigned long long>(c.second));
+
+    std::fputs("# TYPE physics_span_seconds histogram\n", f);
+    for (const auto &h : histograms) {
+        const char *span = h.first.c_str();
+        // Последняя корзина не ограничена сверху и попадает только в +Inf.
+        int last = kBuckets - 2;
+        while (last > 0 && h.second.buckets[last] == 0) --last;
+        uint64_t cumulative = 0;
+        for (int i = 0; i <= last; ++i) {
+            cumulative += h.second.buckets[i];
+            std::fprintf(f, "physics_span_seconds_bucket{span=\"%s\",le=\"%.9g\"} %llu\n",
+                         span, static_cast<double>(2ull << i) * 1e-9,
+                         static_cast<unsigned long long>(cumulative));
+        }
+        std::fprintf(f, "physics_span_seconds_bucket{span=\"%s\",le=\"+Inf\"} %llu\n",
+                     span, static_cast<unsigned long long>(h.second.count));
+        std::fprintf(f, "physics_span_seconds_sum{span=\"%s\"} %.9g\n",
+                     span, h.second.sumNs * 1e-9);
+        std::fprintf(f, "physics_span_seconds_count{span=\"%s\"} %llu\n",
+                     span, static_cast<unsigned long long>(h.second.count));
+    }
+    std::fclose(f);
+}
+
+inline void dump(const std::string &prefix) {
+    writeChromeTrace(prefix + ".trace.json");
+    writePrometheus(prefix + ".metrics.txt");
+}
+
+} // namespace trace
+
+#define TRACE_SPAN(var, name) trace::Span var(name)
+#define TRACE_NEXT(var, name) var.next(name)
+#define TRACE_COUNT(name) trace::count(name)
+#define TRACE_ADD(name, n) trace::count(name, n)
+#define TRACE_DUMP(prefix) trace::dump(prefix)
+
+#else
+
+#define TRACE_SPAN(var, name) ((void)0)
+#define TRACE_NEXT(var, name) ((void)0)
+#define TRACE_COUNT(name) ((void)0)
+#define TRACE_ADD(name, n) ((void)0)
+#define TRACE_DUMP(prefix) ((void)0)
+
+#endif // PHYSICS_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,29 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+// Проверка входных данных без исключений. Каждое условие задачи - свой бит
+// в маске Status, биты идут в порядке проверок и считаются вместе с
+// формулами, без ветвлений, поэтому некорректная строка обходится не
+// дороже корректной. Пользователю показывается сообщение для младшего
+// выставленного бита - первой нарушенной проверки.
+//
+// По той же причине аргумент sqrt в формулах зажимается нулём
+// (std::max(x, 0.0)): корень из отрицательного числа уходит в медленную
+// ветку libm, выставляющую errno. Значения в некорректных строках всё
+// равно не показываются. Сравнение - bench_invalid_rows.sh.
+
+namespace validation {
+
+// Бит за пределами таблицы сообщений задачи (например, table::kOutside)
+// получает общее сообщение; для нулевого статуса сообщения нет.
+template <int N>
+inline const char *message(unsigned status, const char *const (&messages)[N]) {
+    for (int bit = 0; bit < N; ++bit) {
+        if (status & (1u << bit)) return messages[bit];
+    }
+    return status ? "Некорректные входные данные" : "";
+}
+
+} // namespace validation
+
+#endif // VALIDATION_H